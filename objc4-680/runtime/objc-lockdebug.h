@@ -76,6 +76,7 @@ extern void lockdebug_rwlock_assert_reading(rwlock_tt<true> *lock);
 extern void lockdebug_rwlock_assert_writing(rwlock_tt<true> *lock);
 extern void lockdebug_rwlock_assert_locked(rwlock_tt<true> *lock);
 extern void lockdebug_rwlock_assert_unlocked(rwlock_tt<true> *lock);
+extern void lockdebug_rwlock_acquired(rwlock_tt<true> *lock);
 
 static inline void lockdebug_rwlock_read(rwlock_tt<false> *) { }
 static inline void lockdebug_rwlock_try_read_success(rwlock_tt<false> *) { }
@@ -87,3 +88,6 @@ static inline void lockdebug_rwlock_assert_reading(rwlock_tt<false> *) { }
 static inline void lockdebug_rwlock_assert_writing(rwlock_tt<false> *) { }
 static inline void lockdebug_rwlock_assert_locked(rwlock_tt<false> *) { }
 static inline void lockdebug_rwlock_assert_unlocked(rwlock_tt<false> *) { }
+static inline void lockdebug_rwlock_acquired(rwlock_tt<false> *) { }
+
+extern void lockdebug_rwlock_print_times(void);
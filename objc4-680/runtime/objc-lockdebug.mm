@@ -38,6 +38,8 @@ typedef struct {
     void *l;  // the lock itself
     int k;    // the kind of lock it is (MUTEX, MONITOR, etc)
     int i;    // the lock's nest count
+    uint64_t requested;  // rwlocks only: when the lock was requested
+    uint64_t acquired;   // rwlocks only: when the lock was acquired
 } lockcount;
 
 #define MUTEX 1
@@ -113,21 +115,37 @@ hasLock(_objc_lock_list *locks, void *lock, int kind)
 }
 
 
-static void 
-setLock(_objc_lock_list *locks, void *lock, int kind)
+static lockcount *
+findLock(_objc_lock_list *locks, void *lock, int kind)
 {
     int i;
+    if (!locks) return NULL;
+
     for (i = 0; i < locks->used; i++) {
         if (locks->list[i].l == lock  &&  locks->list[i].k == kind) {
-            locks->list[i].i++;
-            return;
+            return &locks->list[i];
         }
     }
+    return NULL;
+}
+
+
+static lockcount *
+setLock(_objc_lock_list *locks, void *lock, int kind)
+{
+    lockcount *entry = findLock(locks, lock, kind);
+    if (entry) {
+        entry->i++;
+        return entry;
+    }
 
-    locks->list[locks->used].l = lock;
-    locks->list[locks->used].i = 1;
-    locks->list[locks->used].k = kind;
-    locks->used++;
+    entry = &locks->list[locks->used++];
+    entry->l = lock;
+    entry->i = 1;
+    entry->k = kind;
+    entry->requested = 0;
+    entry->acquired = 0;
+    return entry;
 }
 
 static void 
@@ -308,6 +326,117 @@ lockdebug_monitor_assert_unlocked(monitor_t *lock)
 }
 
 
+/***********************************************************************
+* rwlock timing
+* With OBJC_PRINT_LOCK_TIMES set, each rwlock acquisition records 
+* how long the thread waited for the lock and how long it held it.
+* Totals are kept per lock and printed at exit.
+**********************************************************************/
+
+typedef struct {
+    void *l;                 // the lock itself
+    uint64_t count[2];       // acquisitions; [0] read, [1] write
+    uint64_t waitTime[2];    // total time spent waiting
+    uint64_t holdTime[2];    // total time spent holding
+    uint64_t maxHoldTime[2]; // longest single hold
+} rwlock_times;
+
+#define RWLOCK_TIMES_COUNT 8
+static rwlock_times RwlockTimes[RWLOCK_TIMES_COUNT];
+
+static rwlock_times *
+timesForLock(void *lock)
+{
+    for (int i = 0; i < RWLOCK_TIMES_COUNT; i++) {
+        rwlock_times *times = &RwlockTimes[i];
+        if (times->l == lock) return times;
+        if (!times->l  &&  
+            OSAtomicCompareAndSwapPtrBarrier(nil, lock, &times->l)) 
+        {
+            return times;
+        }
+        // Lost a race to fill this entry. It may have been for our lock.
+        if (times->l == lock) return times;
+    }
+    return NULL;
+}
+
+static void 
+stampRequested(lockcount *entry)
+{
+    if (PrintLockTimes  &&  entry->i == 1) {
+        entry->requested = nanoseconds();
+        entry->acquired = 0;
+    }
+}
+
+static void 
+stampAcquired(lockcount *entry)
+{
+    if (PrintLockTimes  &&  entry  &&  entry->i == 1  &&  !entry->acquired) {
+        entry->acquired = nanoseconds();
+        if (!entry->requested) entry->requested = entry->acquired;
+    }
+}
+
+static void 
+recordTimes(lockcount *entry)
+{
+    if (!PrintLockTimes  ||  !entry  ||  entry->i != 1  ||  !entry->acquired) {
+        return;
+    }
+
+    rwlock_times *times = timesForLock(entry->l);
+    if (!times) return;
+
+    int w = (entry->k == WRLOCK);
+    uint64_t hold = nanoseconds() - entry->acquired;
+    __sync_fetch_and_add(&times->count[w], 1);
+    __sync_fetch_and_add(&times->waitTime[w], 
+                         entry->acquired - entry->requested);
+    __sync_fetch_and_add(&times->holdTime[w], hold);
+
+    uint64_t oldMax;
+    while (hold > (oldMax = times->maxHoldTime[w])) {
+        if (__sync_bool_compare_and_swap(&times->maxHoldTime[w], 
+                                         oldMax, hold)) break;
+    }
+}
+
+static const char *
+nameForLock(void *lock)
+{
+    if (lock == &selLock) return "selLock";
+#if __OBJC2__
+    if (lock == &runtimeLock) return "runtimeLock";
+#endif
+    return "rwlock";
+}
+
+void 
+lockdebug_rwlock_print_times(void)
+{
+    static const char * const kinds[2] = { "read", "write" };
+
+    for (int i = 0; i < RWLOCK_TIMES_COUNT; i++) {
+        rwlock_times *times = &RwlockTimes[i];
+        if (!times->l) continue;
+        for (int w = 0; w < 2; w++) {
+            if (!times->count[w]) continue;
+            _objc_inform("LOCKS: %s %p %s: %llu acquisitions, "
+                         "%.3f ms waiting, %.3f ms held "
+                         "(avg %.2f us, max %.2f us)", 
+                         nameForLock(times->l), times->l, kinds[w], 
+                         (unsigned long long)times->count[w], 
+                         times->waitTime[w] / 1000000.0, 
+                         times->holdTime[w] / 1000000.0, 
+                         times->holdTime[w] / 1000.0 / times->count[w], 
+                         times->maxHoldTime[w] / 1000.0);
+        }
+    }
+}
+
+
 /***********************************************************************
 * rwlock checking
 **********************************************************************/
@@ -324,7 +453,7 @@ lockdebug_rwlock_read(rwlock_tt<true> *lock)
     if (hasLock(locks, lock, WRLOCK)) {
         _objc_fatal("deadlock: read after write for rwlock");
     }
-    setLock(locks, lock, RDLOCK);
+    stampRequested(setLock(locks, lock, RDLOCK));
 }
 
 // try-read success is the only case with lockdebug effects.
@@ -335,7 +464,7 @@ void
 lockdebug_rwlock_try_read_success(rwlock_tt<true> *lock)
 {
     _objc_lock_list *locks = getLocks(YES);
-    setLock(locks, lock, RDLOCK);
+    stampAcquired(setLock(locks, lock, RDLOCK));
 }
 
 void 
@@ -346,6 +475,7 @@ lockdebug_rwlock_unlock_read(rwlock_tt<true> *lock)
     if (!hasLock(locks, lock, RDLOCK)) {
         _objc_fatal("un-reading unowned rwlock");
     }
+    recordTimes(findLock(locks, lock, RDLOCK));
     clearLock(locks, lock, RDLOCK);
 }
 
@@ -362,7 +492,7 @@ lockdebug_rwlock_write(rwlock_tt<true> *lock)
     if (hasLock(locks, lock, WRLOCK)) {
         _objc_fatal("recursive rwlock write");
     }
-    setLock(locks, lock, WRLOCK);
+    stampRequested(setLock(locks, lock, WRLOCK));
 }
 
 // try-write success is the only case with lockdebug effects.
@@ -373,7 +503,7 @@ void
 lockdebug_rwlock_try_write_success(rwlock_tt<true> *lock)
 {
     _objc_lock_list *locks = getLocks(YES);
-    setLock(locks, lock, WRLOCK);
+    stampAcquired(setLock(locks, lock, WRLOCK));
 }
 
 void 
@@ -384,9 +514,21 @@ lockdebug_rwlock_unlock_write(rwlock_tt<true> *lock)
     if (!hasLock(locks, lock, WRLOCK)) {
         _objc_fatal("un-writing unowned rwlock");
     }
+    recordTimes(findLock(locks, lock, WRLOCK));
     clearLock(locks, lock, WRLOCK);
 }
 
+// Called by read() and write() once the lock is actually held.
+void 
+lockdebug_rwlock_acquired(rwlock_tt<true> *lock)
+{
+    _objc_lock_list *locks = getLocks(NO);
+
+    lockcount *entry = findLock(locks, lock, WRLOCK);
+    if (!entry) entry = findLock(locks, lock, RDLOCK);
+    stampAcquired(entry);
+}
+
 
 void 
 lockdebug_rwlock_assert_reading(rwlock_tt<true> *lock)
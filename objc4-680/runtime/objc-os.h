@@ -81,6 +81,7 @@ class nocopy_t {
 #   include <syslog.h>
 #   include <unistd.h>
 #   include <pthread.h>
+#   include <sched.h>
 #   include <crt_externs.h>
 #   undef check
 #   include <Availability.h>
@@ -89,6 +90,7 @@ class nocopy_t {
 #   include <sys/time.h>
 #   include <sys/stat.h>
 #   include <sys/param.h>
+#   include <sys/sysctl.h>
 #   include <mach/mach.h>
 #   include <mach/vm_param.h>
 #   include <mach/mach_time.h>
@@ -1027,43 +1029,111 @@ static inline void qosEndOverride() { }
 #endif
 
 
+// rwlock_tt is a reader-biased readers-writer lock.
+// Readers announce themselves by incrementing one of several 
+// cache-line-sized reader counts chosen by thread, so readers on 
+// different threads rarely write to the same cache line. 
+// Writers serialize on a mutex, set mWriting to turn new readers away, 
+// and then wait for every reader count to drain. A reader that sees 
+// mWriting backs out and queues behind the writer on the mutex.
+// Reads are cheap and scale with thread count; writes are expensive.
+// Use it only for locks that are read far more often than written, 
+// like runtimeLock and selLock.
 template <bool Debug>
 class rwlock_tt : nocopy_t {
-    pthread_rwlock_t mLock;
+    enum { CacheLineSize = 64 };
+
+#if TARGET_OS_EMBEDDED
+    enum { ReaderSlotCount = 8 };
+#else
+    enum { ReaderSlotCount = 32 };
+#endif
+
+    struct ReaderSlot {
+        intptr_t count alignas(CacheLineSize);
+    };
+
+    ReaderSlot mReaders[ReaderSlotCount];
+    intptr_t mWriting alignas(CacheLineSize);
+    pthread_mutex_t mWriteLock;
+
+    // The same thread always uses the same slot, 
+    // so unlockRead() finds the count that read() incremented.
+    static ReaderSlot& slotForThread(ReaderSlot *slots) {
+        uintptr_t self = (uintptr_t)pthread_self();
+        return slots[((self >> 12) ^ (self >> 7)) % ReaderSlotCount];
+    }
+
+    bool readersDrained() {
+        for (unsigned int i = 0; i < ReaderSlotCount; i++) {
+            if (__atomic_load_n(&mReaders[i].count, __ATOMIC_SEQ_CST)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Returns false if a writer holds or wants the lock.
+    bool tryReadFast(ReaderSlot& slot) {
+        __atomic_fetch_add(&slot.count, 1, __ATOMIC_SEQ_CST);
+        if (!__atomic_load_n(&mWriting, __ATOMIC_SEQ_CST)) return true;
+        __atomic_fetch_sub(&slot.count, 1, __ATOMIC_RELEASE);
+        return false;
+    }
+
+    // Writers set mWriting only while holding mWriteLock, 
+    // so a reader that owns mWriteLock can always enter.
+    void readSlow(ReaderSlot& slot) {
+        int err = pthread_mutex_lock(&mWriteLock);
+        if (err) _objc_fatal("pthread_mutex_lock failed (%d)", err);
+        __atomic_fetch_add(&slot.count, 1, __ATOMIC_SEQ_CST);
+        err = pthread_mutex_unlock(&mWriteLock);
+        if (err) _objc_fatal("pthread_mutex_unlock failed (%d)", err);
+    }
+
+    void waitForReaders() {
+        __atomic_store_n(&mWriting, 1, __ATOMIC_SEQ_CST);
+        unsigned int spins = 0;
+        while (!readersDrained()) {
+            if (++spins < 64) continue;
+            sched_yield();
+        }
+    }
 
   public:
-    rwlock_tt() : mLock(PTHREAD_RWLOCK_INITIALIZER) { }
+    rwlock_tt() : mReaders(), mWriting(0), 
+                  mWriteLock(PTHREAD_MUTEX_INITIALIZER) { }
     
     void read() 
     {
         lockdebug_rwlock_read(this);
 
         qosStartOverride();
-        int err = pthread_rwlock_rdlock(&mLock);
-        if (err) _objc_fatal("pthread_rwlock_rdlock failed (%d)", err);
+        ReaderSlot& slot = slotForThread(mReaders);
+        if (!tryReadFast(slot)) readSlow(slot);
+
+        lockdebug_rwlock_acquired(this);
     }
 
     void unlockRead()
     {
         lockdebug_rwlock_unlock_read(this);
 
-        int err = pthread_rwlock_unlock(&mLock);
-        if (err) _objc_fatal("pthread_rwlock_unlock failed (%d)", err);
+        ReaderSlot& slot = slotForThread(mReaders);
+        intptr_t old = __atomic_fetch_sub(&slot.count, 1, __ATOMIC_RELEASE);
+        if (old <= 0) _objc_fatal("rwlock unlockRead with no readers");
         qosEndOverride();
     }
 
     bool tryRead()
     {
         qosStartOverride();
-        int err = pthread_rwlock_tryrdlock(&mLock);
-        if (err == 0) {
+        if (tryReadFast(slotForThread(mReaders))) {
             lockdebug_rwlock_try_read_success(this);
             return true;
-        } else if (err == EBUSY) {
+        } else {
             qosEndOverride();
             return false;
-        } else {
-            _objc_fatal("pthread_rwlock_tryrdlock failed (%d)", err);
         }
     }
 
@@ -1072,31 +1142,45 @@ class rwlock_tt : nocopy_t {
         lockdebug_rwlock_write(this);
 
         qosStartOverride();
-        int err = pthread_rwlock_wrlock(&mLock);
-        if (err) _objc_fatal("pthread_rwlock_wrlock failed (%d)", err);
+        int err = pthread_mutex_lock(&mWriteLock);
+        if (err) _objc_fatal("pthread_mutex_lock failed (%d)", err);
+        waitForReaders();
+
+        lockdebug_rwlock_acquired(this);
     }
 
     void unlockWrite()
     {
         lockdebug_rwlock_unlock_write(this);
 
-        int err = pthread_rwlock_unlock(&mLock);
-        if (err) _objc_fatal("pthread_rwlock_unlock failed (%d)", err);
+        __atomic_store_n(&mWriting, 0, __ATOMIC_RELEASE);
+        int err = pthread_mutex_unlock(&mWriteLock);
+        if (err) _objc_fatal("pthread_mutex_unlock failed (%d)", err);
         qosEndOverride();
     }
 
     bool tryWrite()
     {
         qosStartOverride();
-        int err = pthread_rwlock_trywrlock(&mLock);
+        int err = pthread_mutex_trylock(&mWriteLock);
         if (err == 0) {
-            lockdebug_rwlock_try_write_success(this);
-            return true;
+            __atomic_store_n(&mWriting, 1, __ATOMIC_SEQ_CST);
+            if (readersDrained()) {
+                lockdebug_rwlock_try_write_success(this);
+                return true;
+            }
+            // Readers are still inside. Let them and anyone we 
+            // turned away proceed.
+            __atomic_store_n(&mWriting, 0, __ATOMIC_RELEASE);
+            err = pthread_mutex_unlock(&mWriteLock);
+            if (err) _objc_fatal("pthread_mutex_unlock failed (%d)", err);
+            qosEndOverride();
+            return false;
         } else if (err == EBUSY) {
             qosEndOverride();
             return false;
         } else {
-            _objc_fatal("pthread_rwlock_trywrlock failed (%d)", err);
+            _objc_fatal("pthread_mutex_trylock failed (%d)", err);
         }
     }
 
@@ -1138,6 +1222,10 @@ typedef struct section_64 sectionType;
 /* Secure /tmp usage */
 extern int secure_open(const char *filename, int flags, uid_t euid);
 
+/* Parallel loops */
+extern void parallel_apply(size_t count, void *context, 
+                           void (*work)(void *context, size_t index));
+
 
 #else
 
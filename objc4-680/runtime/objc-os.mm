@@ -963,6 +963,81 @@ int secure_open(const char *filename, int flags, uid_t euid)
 }
 
 
+/***********************************************************************
+* parallel_apply
+* Calls work(context, i) for every i in [0, count), spread across up 
+* to one thread per active CPU. The calling thread does its share and 
+* returns only after every call has finished. 
+* Work items may run in any order and must not take any lock the 
+* caller holds. This runs during image mapping, before libdispatch 
+* is usable, so it manages its own threads.
+**********************************************************************/
+#define PARALLEL_APPLY_MAX_THREADS 8
+
+struct parallel_apply_t {
+    size_t count;
+    size_t next;
+    void *context;
+    void (*work)(void *context, size_t index);
+};
+
+static void parallel_apply_drain(parallel_apply_t *apply)
+{
+    size_t i;
+    while ((i = __sync_fetch_and_add(&apply->next, 1)) < apply->count) {
+        apply->work(apply->context, i);
+    }
+}
+
+static void *parallel_apply_thread(void *arg)
+{
+    parallel_apply_drain((parallel_apply_t *)arg);
+    return nil;
+}
+
+static unsigned int parallel_apply_width(void)
+{
+    static unsigned int width;
+    if (!width) {
+        int ncpu = 1;
+        size_t len = sizeof(ncpu);
+        if (sysctlbyname("hw.activecpu", &ncpu, &len, nil, 0) < 0  ||  
+            ncpu < 1) 
+        {
+            ncpu = 1;
+        }
+        width = MIN((unsigned int)ncpu, PARALLEL_APPLY_MAX_THREADS);
+    }
+    return width;
+}
+
+void parallel_apply(size_t count, void *context, 
+                    void (*work)(void *context, size_t index))
+{
+    parallel_apply_t apply = { count, 0, context, work };
+    pthread_t threads[PARALLEL_APPLY_MAX_THREADS];
+    unsigned int threadCount = 0;
+
+    unsigned int width = parallel_apply_width();
+    if (width > count) width = (unsigned int)count;
+
+    // If a thread can't be created, the rest of us do its share.
+    for (unsigned int t = 1; t < width; t++) {
+        if (0 == pthread_create(&threads[threadCount], nil, 
+                                &parallel_apply_thread, &apply)) 
+        {
+            threadCount++;
+        }
+    }
+
+    parallel_apply_drain(&apply);
+
+    for (unsigned int t = 0; t < threadCount; t++) {
+        pthread_join(threads[t], nil);
+    }
+}
+
+
 bool crashlog_header_name(header_info *hi)
 {
     return crashlog_header_name_string(hi ? hi->fname : NULL);
@@ -419,6 +419,9 @@ extern bool _hasObjcContents(const header_info *hi);
 /* selectors */
 extern void sel_init(bool gc, size_t selrefCount);
 extern SEL sel_registerNameNoLock(const char *str, bool copy);
+#if __OBJC2__
+extern SEL sel_lookupNameNoLock(const char *str);
+#endif
 extern void sel_lock(void);
 extern void sel_unlock(void);
 
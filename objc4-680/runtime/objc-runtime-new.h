@@ -801,6 +801,11 @@ struct class_rw_t {
 
     char *demangledName;
 
+    // Lazily-built selector => method index over all method lists.
+    // See getMethodNoSuper_nolock().
+    struct method_index_t *methodIndex;
+    uint32_t methodIndexMisses;
+
     void setFlags(uint32_t set) 
     {
         OSAtomicOr32Barrier(set, &flags);
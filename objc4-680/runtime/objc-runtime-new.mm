@@ -53,6 +53,7 @@ static bool methodListImplementsRR(const method_list_t *mlist);
 static bool methodListImplementsAWZ(const method_list_t *mlist);
 static void updateCustomRR_AWZ(Class cls, method_t *meth);
 static method_t *search_method_list(const method_list_t *mlist, SEL sel);
+static void invalidateMethodIndex(Class cls);
 static void flushCaches(Class cls);
 #if SUPPORT_FIXUP
 static void fixupMessageRef(message_ref_t *msg);
@@ -101,6 +102,10 @@ void lock_init(void)
     pthread_key_init_np(QOS_KEY, &destroyQOSKey);
 # endif
 #endif
+
+#if DEBUG
+    if (PrintLockTimes) atexit(&lockdebug_rwlock_print_times);
+#endif
 }
 
 
@@ -616,6 +621,7 @@ attachCategories(Class cls, category_list *cats, bool flush_caches)
     prepareMethodLists(cls, mlists, mcount, NO, fromBundle);
     rw->methods.attachLists(mlists, mcount);
     free(mlists);
+    if (mcount > 0) invalidateMethodIndex(cls);
     if (flush_caches  &&  mcount > 0) flushCaches(cls);
 
     rw->properties.attachLists(proplists, propcount);
@@ -2398,6 +2404,121 @@ readProtocol(protocol_t *newproto, Class protocol_class,
     }
 }
 
+/***********************************************************************
+* Parallel image mapping
+* Resolving selector references and uniquing method lists against 
+* selectors that are already registered only reads the selector table, 
+* so that work is spread across threads while the mapping thread holds 
+* selLock for writing. Anything that needs a new selector is left for 
+* the serial pass, as are class registration, protocols and category 
+* attachment, which depend on image order.
+**********************************************************************/
+#define PARALLEL_SELREF_THRESHOLD 8192
+#define PARALLEL_METHOD_LIST_THRESHOLD 256
+
+struct image_selrefs_t {
+    SEL *sels;
+    size_t count;
+    size_t *misses;    // indexes of sels that are not registered yet
+    size_t missCount;
+};
+
+static void lookUpImageSelrefs(void *context, size_t index)
+{
+    image_selrefs_t *image = (image_selrefs_t *)context + index;
+    if (image->count == 0) return;
+
+    image->misses = (size_t *)malloc(image->count * sizeof(size_t));
+    for (size_t i = 0; i < image->count; i++) {
+        SEL sel = sel_lookupNameNoLock(sel_cname(image->sels[i]));
+        if (sel) image->sels[i] = sel;
+        else image->misses[image->missCount++] = i;
+    }
+}
+
+struct method_list_prefixup_t {
+    method_list_t *mlist;
+    bool sorted;
+};
+
+// Does fixupMethodList()'s uniquing and sorting if every selector 
+// in the list is already registered. Otherwise the list is left 
+// for fixupMethodList() to finish.
+static void prefixupMethodList(void *context, size_t index)
+{
+    method_list_prefixup_t *item = (method_list_prefixup_t *)context + index;
+    method_list_t *mlist = item->mlist;
+
+    for (auto& meth : *mlist) {
+        SEL sel = sel_lookupNameNoLock(sel_cname(meth.name));
+        if (!sel) return;
+        meth.name = sel;
+        if (ignoreSelector(sel)) {
+            meth.imp = (IMP)&_objc_ignored_method;
+        }
+    }
+
+    method_t::SortBySELAddress sorter;
+    std::stable_sort(mlist->begin(), mlist->end(), sorter);
+    item->sorted = true;
+}
+
+static void addPrefixupMethodList(method_list_prefixup_t *&items, 
+                                  size_t &count, method_list_t *mlist)
+{
+    if (!mlist  ||  mlist->isFixedUp()) return;
+    items = (method_list_prefixup_t *)
+        realloc(items, (count+1) * sizeof(*items));
+    items[count].mlist = mlist;
+    items[count].sorted = false;
+    count++;
+}
+
+static const class_ro_t *unrealizedClassRO(Class cls)
+{
+    if (cls->isFuture()) return cls->data()->ro;
+    return (const class_ro_t *)cls->data();
+}
+
+// Fix up the base method lists of the non-lazy classes in hList 
+// in parallel, ahead of their realization.
+static void prefixupNonlazyMethodLists(header_info **hList, uint32_t hCount)
+{
+    runtimeLock.assertWriting();
+
+    method_list_prefixup_t *items = nil;
+    size_t count = 0;
+
+    for (uint32_t h = 0; h < hCount; h++) {
+        size_t classCount;
+        classref_t *classlist = 
+            _getObjc2NonlazyClassList(hList[h], &classCount);
+        for (size_t i = 0; i < classCount; i++) {
+            Class cls = remapClass(classlist[i]);
+            if (!cls  ||  cls->isRealized()) continue;
+            addPrefixupMethodList(items, count, 
+                                  unrealizedClassRO(cls)->baseMethods());
+            Class metacls = cls->ISA();
+            if (metacls->isRealized()) continue;
+            addPrefixupMethodList(items, count, 
+                                  unrealizedClassRO(metacls)->baseMethods());
+        }
+    }
+
+    if (count >= PARALLEL_METHOD_LIST_THRESHOLD) {
+        sel_lock();
+        parallel_apply(count, items, &prefixupMethodList);
+        sel_unlock();
+
+        for (size_t i = 0; i < count; i++) {
+            if (items[i].sorted) items[i].mlist->setFixedUp();
+        }
+    }
+
+    free(items);
+}
+
+
 /***********************************************************************
 * _read_images
 * Perform initial processing of the headers in the linked 
@@ -2552,17 +2673,53 @@ void _read_images(header_info **hList, uint32_t hCount)
     ts.log("IMAGE TIMES: remap classes");
 
     // Fix up @selector references
+    // With enough references, look up the already-registered ones 
+    // in parallel and register only the rest serially.
     static size_t UnfixedSelectors;
-    sel_lock();
+    size_t selrefTotal = 0;
     for (EACH_HEADER) {
         if (hi->isPreoptimized()) continue;
+        _getObjc2SelectorRefs(hi, &count);
+        selrefTotal += count;
+    }
 
-        bool isBundle = hi->isBundle();
-        SEL *sels = _getObjc2SelectorRefs(hi, &count);
-        UnfixedSelectors += count;
-        for (i = 0; i < count; i++) {
-            const char *name = sel_cname(sels[i]);
-            sels[i] = sel_registerNameNoLock(name, isBundle);
+    sel_lock();
+    if (!DisableParallelImages  &&  hCount > 1  &&  
+        selrefTotal >= PARALLEL_SELREF_THRESHOLD) 
+    {
+        image_selrefs_t *images = (image_selrefs_t *)
+            calloc(hCount, sizeof(image_selrefs_t));
+        for (EACH_HEADER) {
+            if (hi->isPreoptimized()) continue;
+            images[hIndex].sels = 
+                _getObjc2SelectorRefs(hi, &images[hIndex].count);
+        }
+
+        parallel_apply(hCount, images, &lookUpImageSelrefs);
+
+        for (EACH_HEADER) {
+            image_selrefs_t& image = images[hIndex];
+            bool isBundle = hi->isBundle();
+            UnfixedSelectors += image.count;
+            for (i = 0; i < image.missCount; i++) {
+                SEL *ref = &image.sels[image.misses[i]];
+                *ref = sel_registerNameNoLock(sel_cname(*ref), isBundle);
+            }
+            free(image.misses);
+        }
+        free(images);
+    }
+    else {
+        for (EACH_HEADER) {
+            if (hi->isPreoptimized()) continue;
+
+            bool isBundle = hi->isBundle();
+            SEL *sels = _getObjc2SelectorRefs(hi, &count);
+            UnfixedSelectors += count;
+            for (i = 0; i < count; i++) {
+                const char *name = sel_cname(sels[i]);
+                sels[i] = sel_registerNameNoLock(name, isBundle);
+            }
         }
     }
     sel_unlock();
@@ -2617,6 +2774,12 @@ void _read_images(header_info **hList, uint32_t hCount)
 
     ts.log("IMAGE TIMES: fix up @protocol references");
 
+    // Unique and sort non-lazy classes' method lists in parallel.
+    if (!DisableParallelImages) {
+        prefixupNonlazyMethodLists(hList, hCount);
+        ts.log("IMAGE TIMES: fix up non-lazy method lists");
+    }
+
     // Realize non-lazy classes (for +load methods and static instances)
     for (EACH_HEADER) {
         classref_t *classlist = 
@@ -4548,6 +4711,93 @@ static method_t *search_method_list(const method_list_t *mlist, SEL sel)
     return nil;
 }
 
+
+/***********************************************************************
+* Method index
+* A selector => method hash table covering every method list attached 
+* to a class, in the same precedence order as the list-by-list search.
+* Classes with many methods and many categories are slow to search 
+* on a cache miss. The index is built only for classes that have 
+* missed often enough and own enough methods to pay for it.
+* 
+* The index is built while runtimeLock is only read-locked, so it 
+* is published with compare-and-swap; the loser of a build race 
+* frees its copy. Anything that changes a class's method lists holds 
+* runtimeLock for writing and discards the index.
+**********************************************************************/
+#define METHOD_INDEX_MISS_THRESHOLD 64
+#define METHOD_INDEX_MIN_METHODS 32
+
+struct method_index_t {
+    uint32_t mask;
+    method_t *buckets[0];
+
+    static size_t byteSize(uint32_t capacity) {
+        return sizeof(method_index_t) + capacity*sizeof(method_t *);
+    }
+};
+
+static method_t *method_index_find(method_index_t *index, SEL sel)
+{
+    uint32_t i = ptr_hash((uintptr_t)sel) & index->mask;
+    method_t *m;
+    while ((m = index->buckets[i])) {
+        if (m->name == sel) return m;
+        i = (i+1) & index->mask;
+    }
+    return nil;
+}
+
+static method_index_t *buildMethodIndex(Class cls)
+{
+    auto& methods = cls->data()->methods;
+    uint32_t count = methods.count();
+    if (count < METHOD_INDEX_MIN_METHODS) return nil;
+
+    // Keep the load factor at or below 1/2.
+    uint32_t capacity = 1;
+    while (capacity < count * 2) capacity *= 2;
+
+    method_index_t *index = (method_index_t *)
+        calloc(method_index_t::byteSize(capacity), 1);
+    index->mask = capacity - 1;
+
+    // Lists are visited newest first and methods within a sorted list 
+    // in order, so the first entry seen for each selector is the one 
+    // search_method_list() would have found. Later duplicates are 
+    // overridden methods and are skipped.
+    for (auto& meth : methods) {
+        uint32_t i = ptr_hash((uintptr_t)meth.name) & index->mask;
+        method_t *m;
+        while ((m = index->buckets[i])) {
+            if (m->name == meth.name) break;
+            i = (i+1) & index->mask;
+        }
+        if (!m) index->buckets[i] = &meth;
+    }
+
+    return index;
+}
+
+
+/***********************************************************************
+* invalidateMethodIndex
+* Discards cls's method index after its method lists changed.
+* Locking: runtimeLock must be write-locked by the caller
+**********************************************************************/
+static void invalidateMethodIndex(Class cls)
+{
+    runtimeLock.assertWriting();
+
+    auto rw = cls->data();
+    if (rw->methodIndex) {
+        free(rw->methodIndex);
+        rw->methodIndex = nil;
+    }
+    rw->methodIndexMisses = 0;
+}
+
+
 static method_t *
 getMethodNoSuper_nolock(Class cls, SEL sel)
 {
@@ -4557,8 +4807,27 @@ getMethodNoSuper_nolock(Class cls, SEL sel)
     // fixme nil cls? 
     // fixme nil sel?
 
-    for (auto mlists = cls->data()->methods.beginLists(), 
-              end = cls->data()->methods.endLists(); 
+    auto rw = cls->data();
+    method_index_t *index = rw->methodIndex;
+    if (index) return method_index_find(index, sel);
+
+    // Racy increment is fine: the count is only a heuristic.
+    if (++rw->methodIndexMisses == METHOD_INDEX_MISS_THRESHOLD) {
+        index = buildMethodIndex(cls);
+        if (index) {
+            if (OSAtomicCompareAndSwapPtrBarrier(nil, index, 
+                                                 (void**)&rw->methodIndex)) 
+            {
+                return method_index_find(index, sel);
+            }
+            // Some other reader built one first.
+            free(index);
+            return method_index_find(rw->methodIndex, sel);
+        }
+    }
+
+    for (auto mlists = rw->methods.beginLists(), 
+              end = rw->methods.endLists(); 
          mlists != end;
          ++mlists)
     {
@@ -5532,6 +5801,7 @@ addMethod(Class cls, SEL name, IMP imp, const char *types, bool replace)
 
         prepareMethodLists(cls, &newlist, 1, NO, NO);
         cls->data()->methods.attachLists(&newlist, 1);
+        invalidateMethodIndex(cls);
         flushCaches(cls);
 
         result = nil;
@@ -6136,6 +6406,7 @@ static void free_class(Class cls)
     auto ro = rw->ro;
 
     cache_delete(cls);
+    invalidateMethodIndex(cls);
     
     for (auto& meth : rw->methods) {
         try_free(meth.types);
@@ -3285,6 +3285,9 @@ recursive_mutex_t loadMethodLock;
 
 void lock_init(void)
 {
+#if DEBUG
+    if (PrintLockTimes) atexit(&lockdebug_rwlock_print_times);
+#endif
 }
 
 
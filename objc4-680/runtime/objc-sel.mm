@@ -197,6 +197,25 @@ SEL sel_registerNameNoLock(const char *name, bool copy) {
     return __sel_registerName(name, 0, copy);  // NO lock, maybe copy
 }
 
+
+/***********************************************************************
+* sel_lookupNameNoLock
+* Returns the registered selector for name, or nil if there is none.
+* Never inserts. Several threads may call this at once provided 
+* some thread holds selLock for writing on their behalf, so that 
+* nothing can be inserted concurrently. Used by parallel image mapping.
+**********************************************************************/
+SEL sel_lookupNameNoLock(const char *name)
+{
+    SEL result = search_builtins(name);
+    if (result) return result;
+
+    if (namedSelectors) {
+        result = (SEL)NXMapGet(namedSelectors, name);
+    }
+    return result;
+}
+
 void sel_lock(void)
 {
     selLock.write();
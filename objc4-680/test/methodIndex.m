@@ -0,0 +1,65 @@
+// TEST_CONFIG
+
+#include "test.h"
+#include "testroot.i"
+#include <objc/runtime.h>
+
+// Method lookup in classes with many methods goes through a lazily-built
+// method index once the class misses its cache often enough.
+// Verify the index gives the same answers as the list search,
+// and that adding methods afterwards is still seen.
+
+#define METHODS 256
+
+@interface Big : TestRoot @end
+@implementation Big @end
+
+static id fn(id self __attribute__((unused)), SEL cmd __attribute__((unused)), ...) { return nil; }
+static id fn2(id self __attribute__((unused)), SEL cmd __attribute__((unused)), ...) { return nil; }
+static id fn3(id self __attribute__((unused)), SEL cmd __attribute__((unused)), ...) { return nil; }
+
+static SEL selectorNamed(const char *prefix, int i)
+{
+    char *name;
+    asprintf(&name, "%s%d", prefix, i);
+    SEL result = sel_registerName(name);
+    free(name);
+    return result;
+}
+
+int main()
+{
+    Class cls = [Big class];
+    int i, pass;
+
+    for (i = 0; i < METHODS; i++) {
+        testassert(class_addMethod(cls, selectorNamed("method", i), (IMP)fn, ""));
+    }
+
+    // Miss repeatedly: each uncached lookup goes to the method lists.
+    for (pass = 0; pass < 4; pass++) {
+        for (i = 0; i < METHODS; i++) {
+            _objc_flush_caches(cls);
+            testassert(class_getMethodImplementation(cls, selectorNamed("method", i)) == (IMP)fn);
+            testassert(!class_respondsToSelector(cls, selectorNamed("missing", i)));
+        }
+    }
+
+    // Methods added after the index was built must be found.
+    testassert(class_addMethod(cls, selectorNamed("late", 0), (IMP)fn2, ""));
+    testassert(class_getMethodImplementation(cls, selectorNamed("late", 0)) == (IMP)fn2);
+
+    // Replaced implementations must be visible through the index.
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < METHODS; i++) {
+            _objc_flush_caches(cls);
+            testassert(class_getMethodImplementation(cls, selectorNamed("method", i)) == (IMP)fn);
+        }
+    }
+    testassert(class_replaceMethod(cls, selectorNamed("method", 7), (IMP)fn3, "") == (IMP)fn);
+    testassert(class_getMethodImplementation(cls, selectorNamed("method", 7)) == (IMP)fn3);
+    testassert(class_getInstanceMethod(cls, selectorNamed("method", 8)));
+    testassert(method_getImplementation(class_getInstanceMethod(cls, selectorNamed("method", 7))) == (IMP)fn3);
+
+    succeed(__FILE__);
+}